@@ -34,6 +34,13 @@ class MySudokuSolver(ExecutableTool):
 
         # For example to run the solver as ./solver [sat_solver] [task]:
         solver = self.parameters.get("solver")
+
+        # With a `socket` parameter the task is sent to a resident
+        # `./solver --serve [socket]` instead (solved locally if none runs)
+        socket = self.parameters.get("socket")
+        if socket:
+            return [self.path, "--client", socket, solver, self.task]
+
         return [self.path, solver, self.task]
 
     @classmethod
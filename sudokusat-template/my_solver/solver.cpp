@@ -1,37 +1,42 @@
 #include <iostream>
 #include <stdlib.h>
 #include <cstring>
+#include <cerrno>
 #include <fstream>
+#include <sstream>
+#include <iterator>
 #include <math.h>
 #include <ctime>
 #include <map>
 #include <vector>
+#include <cstdint>
 #include <csignal>
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <poll.h>
+#include <exception>
 
 struct Sudoku {
     std::string parameters = "";
-    int * field;
+    int * field = nullptr;
     unsigned int blockSize = 0;
     unsigned int size = 0;
     unsigned int numberLength = 0;
-    bool * columnValues;
-    bool * rowValues;
-    bool * blockValues;
-    std::vector<std::string> mappingLiteralIndexToValue;
-    std::map<std::string, int> mappingLiteralIndexToValueIndex;
+    bool * columnValues = nullptr;
+    bool * rowValues = nullptr;
+    bool * blockValues = nullptr;
+    //compact literal - 1 -> sudoku literal
+    std::vector<int> mappingLiteralIndexToValue;
 
     int get(int x, int y) const;
 
     void set(int x, int y, int value);
     
-    bool isCellValueSet(int x, int y) const;
-
-    bool isValueSatisfied(int x, int y, int value, bool checkBlock = true, bool checkColumn = true, bool checkRow = true) const;
-
     /**
      * @brief Assign values to easy fields
      * 
@@ -41,12 +46,69 @@ struct Sudoku {
      */
     int reduceEasyFields();
 
+    /**
+     * @brief Checks the field against the clues and all row/column/block
+     *        constraints in one pass, unset cells (-1) are reported as well
+     * 
+     * @param clues field as it was read, before any optimization
+     * @return true valid solution
+     */
+    bool verify(const std::vector<int> &clues) const;
+
+    /**
+     * @brief Appends the printed sudoku to out
+     * 
+     * @param out 
+     */
+    void render(std::string &out) const;
+
+    /**
+     * @brief Renders the sudoku and writes it to stdout with a single write
+     */
     void print() const;
 
     void free();
 };
 
+//sudoku literal - 1 -> compact literal, shared by all sudokus so the server
+//fills it only once. Entries left by earlier sudokus are never cleared, they
+//are detected by checking them against Sudoku::mappingLiteralIndexToValue
+std::vector<int> mappingLiteralIndexToValueIndex;
+
+//socket of a running server, removed again on termination
+const char * serverSocketPath = nullptr;
+
+//client of the request the server is working on, -1 outside of server mode
+int solverClientFd = -1;
+//set if the solver was stopped because solverClientFd hung up
+bool solverCancelled = false;
+//solver started by the server, runs in its own process group
+volatile pid_t serverSolverPid = -1;
+//written on SIGCHLD so the server can wait for the solver and its client at once
+int childPipe[2] = {-1, -1};
+
+//a whole request has to arrive (and its answer be taken) within this time
+const int requestTimeoutSeconds = 10;
+//default time a client waits for the server before solving locally
+const int clientTimeoutSeconds = 10;
+//largest accepted sudoku, the literal table of the encoder takes size^3 ints
+const unsigned int maxSudokuSize = 256;
+//the text of a 256x256 sudoku is about 300 KB
+const size_t maxRequestSize = 1 << 20;
+
+void childSignalHandler(int signal) {
+    int savedErrno = errno;
+    if(write(childPipe[1], "c", 1) < 0) {}
+    errno = savedErrno;
+}
+
 void signalHandler(int signal) {    
+    if(serverSocketPath != nullptr) {
+        unlink(serverSocketPath);
+    }
+    if(serverSolverPid > 0) {
+        killpg(serverSolverPid, SIGKILL);
+    }
     killpg(getpgid(getpid()), SIGKILL);
 }
 
@@ -62,6 +124,17 @@ void signalHandler(int signal) {
  */
 Sudoku readSudoku(const char * path);
 
+/**
+ * @brief Parses sudoku from an already opened stream
+ * 
+ * Malformed input (bad size, short or missing lines, values out of range)
+ * results in an empty sudoku with size 0
+ * 
+ * @param sudokuFile 
+ * @return Sudoku 
+ */
+Sudoku readSudoku(std::istream &sudokuFile);
+
 /**
  * @brief Encodes sudoku to cnf formular
  * 
@@ -72,6 +145,109 @@ Sudoku readSudoku(const char * path);
  */
 void encodeSudoku(Sudoku &sudoku);
 
+/**
+ * @brief Encodes sudoku into a caller owned buffer
+ * 
+ * The buffer is cleared but keeps its capacity, so a server
+ * does not have to grow it again for every request
+ * 
+ * @param sudoku 
+ * @param cnf 
+ */
+void encodeSudoku(Sudoku &sudoku, std::string &cnf);
+
+/**
+ * @brief Encodes sudoku to pseudo-Boolean constraints (OPB) in sudoku.opb
+ * 
+ * Every cell, row, column and block gets one exactly-one constraint
+ * instead of the pairwise clauses of the cnf encoding, for solvers
+ * with native cardinality support (clasp)
+ * 
+ * @param sudoku 
+ * @param opb reusable encoding buffer
+ */
+void encodeSudokuPb(Sudoku &sudoku, std::string &opb);
+
+/**
+ * @brief Solver takes the OPB encoding instead of DIMACS
+ * 
+ * @param solver 
+ * @return true 
+ */
+bool isPseudoBooleanSolver(std::string solver);
+
+/**
+ * @brief Grid dimensions known at compile time
+ * 
+ * Lets the compiler replace divisions by blockSize with cheap
+ * arithmetic in the kernels below
+ */
+template<unsigned int BlockSize>
+struct FixedGrid {
+    explicit FixedGrid(const Sudoku &) {}
+    static constexpr int blockSize() { return BlockSize; }
+    static constexpr int size() { return BlockSize * BlockSize; }
+};
+
+/**
+ * @brief Grid dimensions only known at runtime, used for uncommon sizes
+ */
+struct RuntimeGrid {
+    explicit RuntimeGrid(const Sudoku &sudoku) : blockSizeValue(sudoku.blockSize), sizeValue(sudoku.size) {}
+    int blockSize() const { return blockSizeValue; }
+    int size() const { return sizeValue; }
+
+    int blockSizeValue;
+    int sizeValue;
+};
+
+/**
+ * @brief Calls kernel with the FixedGrid matching the sudoku (block sizes of
+ *        the instance tables) or a RuntimeGrid otherwise
+ * 
+ * @param sudoku 
+ * @param kernel functor with a templated operator()(const Grid &)
+ * @return Result result of the kernel
+ */
+template<typename Result, typename Kernel>
+Result dispatchGrid(const Sudoku &sudoku, Kernel kernel);
+
+template<typename Grid>
+bool isCellValueSet(const Sudoku &sudoku, const Grid &grid, int x, int y);
+
+template<typename Grid>
+bool isValueSatisfied(const Sudoku &sudoku, const Grid &grid, int x, int y, int value);
+
+/**
+ * @brief Grid specialized kernel of Sudoku::reduceEasyFields
+ * 
+ * @param sudoku 
+ * @param grid 
+ * @return int optimized fields
+ */
+template<typename Grid>
+int reduceEasyFields(Sudoku &sudoku, const Grid &grid);
+
+/**
+ * @brief Grid specialized kernel of encodeSudoku
+ * 
+ * @param sudoku 
+ * @param cnf 
+ * @param grid 
+ */
+template<typename Grid>
+void encodeSudoku(Sudoku &sudoku, std::string &cnf, const Grid &grid);
+
+/**
+ * @brief Grid specialized kernel of encodeSudokuPb
+ * 
+ * @param sudoku 
+ * @param opb 
+ * @param grid 
+ */
+template<typename Grid>
+void encodeSudokuPb(Sudoku &sudoku, std::string &opb, const Grid &grid);
+
 /**
  * @brief 
  * 
@@ -84,6 +260,18 @@ void encodeSudoku(Sudoku &sudoku);
  */
 std::string valueToLiteral(Sudoku & sudoku, int x, int y, int v, bool isTrue = true);
 
+/**
+ * @brief Appends the literal of valueToLiteral to out without temporary strings
+ * 
+ * @param out 
+ * @param sudoku 
+ * @param x 
+ * @param y 
+ * @param v 
+ * @param isTrue 
+ */
+void appendLiteral(std::string &out, Sudoku &sudoku, int x, int y, int v, bool isTrue = true);
+
 /**
  * @brief Convert sat literal to real x/y coordiantes and the value
  * 
@@ -105,6 +293,14 @@ void literalToValue(Sudoku &sudoku, int &x, int &y, int &v, int value);
  */
 void solve(std::string solver);
 
+/**
+ * @brief Solver is one of the backends solve() can run
+ * 
+ * @param solver 
+ * @return true 
+ */
+bool isKnownSolver(std::string solver);
+
 /**
  * @brief Parses sat solver files
  * 
@@ -116,6 +312,54 @@ void solve(std::string solver);
  */
 void parseSolution(std::string solver, Sudoku &sudoku);
 
+/**
+ * @brief Runs the whole pipeline (optimize, encode, solve, parse)
+ *        and verifies the result
+ * 
+ * @param solver 
+ * @param sudoku 
+ * @param cnf reusable encoding buffer
+ * @return true solution is valid
+ */
+bool solveSudoku(std::string solver, Sudoku &sudoku, std::string &cnf);
+
+/**
+ * @brief Keeps the solver resident and answers requests on a unix socket
+ * 
+ * Request:  "<sat solver>\n" followed by the sudoku in the input format,
+ *           terminated by closing the write side of the connection
+ * Response: "valid\n" or "invalid\n" (verification result) followed by
+ *           the printed sudoku, or "error <reason>\n",
+ *           the connection is closed afterwards
+ * 
+ * Requests are handled one after another because the solvers share
+ * sudoku.cnf/sudoku.opb and sudoku.sol in the working directory.
+ * A request is dropped (and its solver stopped) once its client hangs up.
+ * Requests have to arrive completely within requestTimeoutSeconds and
+ * must not be larger than maxRequestSize.
+ * 
+ * @param socketPath 
+ * @return int exit code
+ */
+int runServer(const char * socketPath);
+
+/**
+ * @brief Sends a sudoku file to a running server and prints the answer
+ * 
+ * Falls back to solving in this process if no server is reachable,
+ * the server closes the connection without an answer or does not
+ * answer within timeoutSeconds (e.g. because it is busy with a large sudoku)
+ * 
+ * Exits like a local solve: 1 for invalid solutions and errors
+ * 
+ * @param socketPath 
+ * @param solver 
+ * @param path 
+ * @param timeoutSeconds 
+ * @return int exit code
+ */
+int runClient(const char * socketPath, std::string solver, const char * path, int timeoutSeconds);
+
 void validate(Sudoku & sudoku);
 
 int main(int argc, char **argv) {
@@ -123,114 +367,554 @@ int main(int argc, char **argv) {
 
     signal(SIGTERM, signalHandler);
     signal(SIGINT, signalHandler);
+
+    if(argc > 2 && std::string(argv[1]) == "--serve") {
+        return runServer(argv[2]);
+    }
+    if(argc > 4 && std::string(argv[1]) == "--client") {
+        int timeoutSeconds = argc > 5 ? std::atoi(argv[5]) : clientTimeoutSeconds;
+        return runClient(argv[2], argv[3], argv[4], timeoutSeconds > 0 ? timeoutSeconds : clientTimeoutSeconds);
+    }
+
+    if(!isKnownSolver(argv[1])) {
+        std::cerr << "Unknown solver " << argv[1] << std::endl;
+        return 1;
+    }
     
     Sudoku sudoku = readSudoku(argv[2]);
     //debugging break
     if(sudoku.size > 0) {
         //validate(sudoku);
+        std::string cnf;
+        bool valid = solveSudoku(argv[1], sudoku, cnf);
+        sudoku.print();
+        sudoku.free();
+        return valid ? 0 : 1;
+    }
+    std::cerr << "Invalid sudoku " << argv[2] << std::endl;
+    
+    return 1;
+}
 
-        clock_t startTime = clock();
-        //reduce complexity by removing simple sudoku fields
-        while(sudoku.reduceEasyFields() > 0) {
-            if((double(clock() - startTime) / CLOCKS_PER_SEC) > 0.25) {
-                break;
+bool solveSudoku(std::string solver, Sudoku &sudoku, std::string &cnf) {
+    std::vector<int> clues(sudoku.field, sudoku.field + sudoku.size * sudoku.size);
+
+    clock_t startTime = clock();
+    //reduce complexity by removing simple sudoku fields
+    while(sudoku.reduceEasyFields() > 0) {
+        if((double(clock() - startTime) / CLOCKS_PER_SEC) > 0.25) {
+            break;
+        }
+    }
+    std::cerr << "Optimization " << (double(clock() - startTime) / CLOCKS_PER_SEC) << "s " << std::endl;
+
+    if(isPseudoBooleanSolver(solver)) {
+        encodeSudokuPb(sudoku, cnf);
+    }
+    else {
+        encodeSudoku(sudoku, cnf);
+    }
+    solve(solver);  
+    if(solverCancelled) {
+        return false;
+    }
+    parseSolution(solver, sudoku);
+
+    startTime = clock();
+    bool valid = sudoku.verify(clues);
+    std::cerr << "Verification " << (valid ? "Valid " : "Invalid ") << (double(clock() - startTime) / CLOCKS_PER_SEC) << "s" << std::endl;
+    return valid;
+}
+
+/**
+ * @brief Monotonic clock for deadlines
+ * 
+ * @return long long milliseconds
+ */
+static long long currentMilliseconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Waits until fd is ready for events
+ * 
+ * @param fd 
+ * @param events POLLIN or POLLOUT
+ * @param deadline currentMilliseconds() based, -1 waits forever
+ * @return false if the deadline passed (errno = ETIMEDOUT)
+ */
+static bool waitForFd(int fd, short events, long long deadline) {
+    if(deadline < 0) {
+        return true;
+    }
+    while(true) {
+        long long remaining = deadline - currentMilliseconds();
+        if(remaining <= 0) {
+            errno = ETIMEDOUT;
+            return false;
+        }
+        pollfd ready = {fd, events, 0};
+        int result = poll(&ready, 1, (int)remaining);
+        if(result > 0) {
+            return true;
+        }
+        if(result < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Writes the whole buffer, retrying on partial writes
+ * 
+ * @param fd 
+ * @param data 
+ * @param length 
+ * @param deadline for all bytes, -1 without limit
+ * @return true all bytes written
+ */
+static bool writeAll(int fd, const char * data, size_t length, long long deadline = -1) {
+    while(length > 0) {
+        if(!waitForFd(fd, POLLOUT, deadline)) {
+            return false;
+        }
+        ssize_t written = write(fd, data, length);
+        if(written < 0) {
+            if(errno == EINTR || errno == EAGAIN) {
+                continue;
             }
+            return false;
         }
-        std::cerr << "Optimization " << (double(clock() - startTime) / CLOCKS_PER_SEC) << "s " << std::endl;
+        data += written;
+        length -= written;
+    }
+    return true;
+}
 
-        encodeSudoku(sudoku);               
-        solve(argv[1]);  
-        parseSolution(argv[1], sudoku);
-        sudoku.print();
+/**
+ * @brief Reads from fd until the peer closes its write side
+ * 
+ * @param fd 
+ * @param data 
+ * @param maxSize larger streams are rejected (errno = EMSGSIZE)
+ * @param deadline for the whole stream, -1 without limit
+ * @return true end of stream reached, false on errors and timeouts
+ */
+static bool readAll(int fd, std::string &data, size_t maxSize, long long deadline) {
+    char buffer[65536];
+    while(true) {
+        if(!waitForFd(fd, POLLIN, deadline)) {
+            return false;
+        }
+        ssize_t received = read(fd, buffer, sizeof(buffer));
+        if(received < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if(received < 0) {
+            return false;
+        }
+        if(received == 0) {
+            return true;
+        }
+        if(data.size() + received > maxSize) {
+            errno = EMSGSIZE;
+            return false;
+        }
+        data.append(buffer, received);
+    }
+}
+
+/**
+ * @brief Checks if the peer closed its side of the connection completely
+ * 
+ * A peer that only shut down writing (end of request) is not gone
+ * 
+ * @param fd 
+ * @return true 
+ */
+static bool isPeerGone(int fd) {
+    pollfd peer = {fd, 0, 0};
+    return poll(&peer, 1, 0) > 0 && (peer.revents & (POLLHUP | POLLERR));
+}
+
+/**
+ * @brief Solves a sudoku given as text in this process and prints it
+ * 
+ * @param solver 
+ * @param sudokuText 
+ * @return int exit code
+ */
+static int solveLocally(std::string solver, const std::string &sudokuText) {
+    if(!isKnownSolver(solver)) {
+        std::cerr << "Unknown solver " << solver << std::endl;
+        return 1;
+    }
+    std::istringstream sudokuStream(sudokuText);
+    Sudoku sudoku = readSudoku(sudokuStream);
+    if(sudoku.size == 0) {
+        std::cerr << "Invalid sudoku" << std::endl;
+        return 1;
+    }
+    std::string cnf;
+    bool valid = solveSudoku(solver, sudoku, cnf);
+    sudoku.print();
+    sudoku.free();
+    return valid ? 0 : 1;
+}
+
+/**
+ * @brief Answers a single server request
+ * 
+ * @param clientFd 
+ * @param request "<sat solver>\n<sudoku>"
+ * @param cnf reusable encoding buffer
+ * @param response reusable answer buffer, empty if the request was dropped
+ */
+static void handleRequest(int clientFd, const std::string &request, std::string &cnf, std::string &response) {
+    response.clear();
+
+    size_t solverEnd = request.find('\n');
+    if(solverEnd == std::string::npos) {
+        response = "error missing solver\n";
+        return;
+    }
+    std::string solver = request.substr(0, solverEnd);
+    if(!isKnownSolver(solver)) {
+        response = "error unknown solver\n";
+        return;
+    }
+    std::istringstream sudokuStream(request.substr(solverEnd + 1));
+    Sudoku sudoku = readSudoku(sudokuStream);
+    if(sudoku.size == 0) {
+        response = "error invalid sudoku\n";
+        return;
+    }
+
+    bool valid = false;
+    try {
+        solverClientFd = clientFd;
+        solverCancelled = false;
+        valid = solveSudoku(solver, sudoku, cnf);
+        solverClientFd = -1;
+    }
+    catch(...) {
+        solverClientFd = -1;
         sudoku.free();
+        throw;
     }
-    
-    return 0;
+
+    if(!solverCancelled) {
+        response = valid ? "valid\n" : "invalid\n";
+        sudoku.render(response);
+    }
+    sudoku.free();
+}
+
+/**
+ * @brief Fills a unix socket address, fails on paths that do not fit
+ * 
+ * @param address 
+ * @param socketPath 
+ * @return true 
+ */
+static bool toSocketAddress(sockaddr_un &address, const char * socketPath) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(std::strlen(socketPath) >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long " << socketPath << std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, socketPath);
+    return true;
+}
+
+int runServer(const char * socketPath) {
+    sockaddr_un address;
+    if(!toSocketAddress(address, socketPath)) {
+        return 1;
+    }
+
+    //close on exec, the sat solver must not inherit the server sockets
+    int serverFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(serverFd < 0) {
+        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    //remove stale socket of a previous server
+    unlink(socketPath);
+    if(bind(serverFd, (sockaddr *)&address, sizeof(address)) < 0 || listen(serverFd, 64) < 0) {
+        std::cerr << "Failed to listen on " << socketPath << ": " << strerror(errno) << std::endl;
+        close(serverFd);
+        return 1;
+    }
+    if(pipe2(childPipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        std::cerr << "Failed to create pipe: " << strerror(errno) << std::endl;
+        close(serverFd);
+        unlink(socketPath);
+        return 1;
+    }
+    serverSocketPath = socketPath;
+    signal(SIGCHLD, childSignalHandler);
+    //clients may disconnect before their answer is written
+    signal(SIGPIPE, SIG_IGN);
+    std::cerr << "Listening on " << socketPath << std::endl;
+
+    //buffers are kept across requests so they only grow once
+    std::string request;
+    std::string cnf;
+    std::string response;
+    while(true) {
+        int clientFd = accept4(serverFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if(clientFd < 0) {
+            if(errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            std::cerr << "Failed to accept client: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        //a client that never finishes its request must not block the server,
+        //reads and writes wait for one deadline instead of blocking
+        fcntl(clientFd, F_SETFL, fcntl(clientFd, F_GETFL) | O_NONBLOCK);
+
+        request.clear();
+        if(!readAll(clientFd, request, maxRequestSize, currentMilliseconds() + requestTimeoutSeconds * 1000)) {
+            std::cerr << "Incomplete request: " << strerror(errno) << std::endl;
+            response = errno == EMSGSIZE ? "error request too large\n" : "error incomplete request\n";
+        }
+        else if(isPeerGone(clientFd)) {
+            std::cerr << "Client gone, request dropped" << std::endl;
+            response.clear();
+        }
+        else {
+            try {
+                handleRequest(clientFd, request, cnf, response);
+                if(solverCancelled) {
+                    std::cerr << "Client gone, request dropped" << std::endl;
+                }
+            }
+            catch(const std::exception &exception) {
+                std::cerr << "Request failed: " << exception.what() << std::endl;
+                response = std::string("error ") + exception.what() + "\n";
+            }
+        }
+        writeAll(clientFd, response.data(), response.size(), currentMilliseconds() + requestTimeoutSeconds * 1000);
+        close(clientFd);
+    }
+
+    close(childPipe[0]);
+    close(childPipe[1]);
+    close(serverFd);
+    unlink(socketPath);
+    serverSocketPath = nullptr;
+    return 1;
+}
+
+int runClient(const char * socketPath, std::string solver, const char * path, int timeoutSeconds) {
+    std::fstream sudokuFile(path, std::fstream::in);
+    if(!sudokuFile.good()) {
+        return 1;
+    }
+    std::string request = solver + "\n";
+    request.append(std::istreambuf_iterator<char>(sudokuFile), std::istreambuf_iterator<char>());
+    sudokuFile.close();
+
+    sockaddr_un address;
+    int clientFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(clientFd < 0 || !toSocketAddress(address, socketPath) || connect(clientFd, (sockaddr *)&address, sizeof(address)) < 0) {
+        std::cerr << "No server on " << socketPath << ", solving locally" << std::endl;
+        if(clientFd >= 0) {
+            close(clientFd);
+        }
+        return solveLocally(solver, request.substr(solver.size() + 1));
+    }
+
+    //a busy server (e.g. with a large sudoku) must not hold small ones
+    long long deadline = currentMilliseconds() + timeoutSeconds * 1000LL;
+    fcntl(clientFd, F_SETFL, fcntl(clientFd, F_GETFL) | O_NONBLOCK);
+
+    std::string response;
+    bool answered = writeAll(clientFd, request.data(), request.size(), deadline);
+    if(answered) {
+        shutdown(clientFd, SHUT_WR);
+        answered = readAll(clientFd, response, std::string::npos, deadline);
+    }
+    //closing also makes the server drop the request
+    close(clientFd);
+
+    size_t statusEnd = response.find('\n');
+    if(!answered || statusEnd == std::string::npos) {
+        std::cerr << "No answer from " << socketPath << " (" << strerror(errno) << "), solving locally" << std::endl;
+        return solveLocally(solver, request.substr(solver.size() + 1));
+    }
+    std::string status = response.substr(0, statusEnd);
+    if(status != "valid" && status != "invalid") {
+        std::cerr << "Server: " << status << std::endl;
+        return 1;
+    }
+    writeAll(STDOUT_FILENO, response.data() + statusEnd + 1, response.size() - statusEnd - 1);
+    return status == "valid" ? 0 : 1;
 }
 
 Sudoku readSudoku(const char * path) {
     std::fstream sudokuFile(path, std::fstream::in);
-    Sudoku sudoku;
+    if(!sudokuFile.good()) {
+        return Sudoku();
+    }
+    return readSudoku(sudokuFile);
+}
 
+/**
+ * @brief Parses the sudoku lines into sudoku
+ * 
+ * @param sudokuFile 
+ * @param sudoku 
+ * @return false on malformed input
+ */
+static bool readSudokuLines(std::istream &sudokuFile, Sudoku &sudoku) {
+    std::string line;
     int lineCount = 0;
-    if(sudokuFile.good()) {
-        std::string line;
-        int lineCount = 0;
 
-        int blockSize = 0;
-        
-        int row = 0;
-
-        while (std::getline(sudokuFile, line))
-        {
-            if(lineCount < 4) {
-                sudoku.parameters += line + "\n";
-                if(line.size() > 13) {
-                    if(line.substr(0, 12) == "puzzle size:"){
-                        std::string sizeStr = line.substr(13, line.length() - 13);
-                        for(int i = 0; i < sizeStr.length(); i++) {
-                            if(sizeStr[i] == 'x') {
-                                std::string fieldSize = sizeStr.substr(0, i);
-                                sudoku.numberLength = fieldSize.size();
-                                sudoku.size = std::stoi(fieldSize);
-                                sudoku.blockSize = sqrt(sudoku.size);
-                                sudoku.field = new int[sudoku.size * sudoku.size];
-                                sudoku.columnValues = new bool[sudoku.size * sudoku.size];
-                                sudoku.rowValues    = new bool[sudoku.size * sudoku.size];
-                                sudoku.blockValues  = new bool[sudoku.size * sudoku.size];
-                                std::memset(sudoku.columnValues, false, sizeof(bool) * sudoku.size * sudoku.size);
-                                std::memset(sudoku.rowValues,    false, sizeof(bool) * sudoku.size * sudoku.size);
-                                std::memset(sudoku.blockValues,  false, sizeof(bool) * sudoku.size * sudoku.size);
-                                blockSize = sqrt(sudoku.size);
-                                break;
+    int blockSize = 0;
+    
+    unsigned int row = 0;
+
+    while (std::getline(sudokuFile, line))
+    {
+        if(lineCount < 4) {
+            sudoku.parameters += line + "\n";
+            if(line.size() > 13) {
+                if(line.substr(0, 12) == "puzzle size:"){
+                    if(sudoku.field != nullptr) {
+                        return false;
+                    }
+                    std::string sizeStr = line.substr(13, line.length() - 13);
+                    for(int i = 0; i < sizeStr.length(); i++) {
+                        if(sizeStr[i] == 'x') {
+                            std::string fieldSize = sizeStr.substr(0, i);
+                            sudoku.numberLength = fieldSize.size();
+                            int size = std::stoi(fieldSize);
+                            if(size <= 0 || size > (int)maxSudokuSize) {
+                                return false;
                             }
+                            sudoku.size = size;
+                            sudoku.blockSize = sqrt(sudoku.size);
+                            if(sudoku.blockSize * sudoku.blockSize != sudoku.size) {
+                                return false;
+                            }
+                            sudoku.field = new int[sudoku.size * sudoku.size];
+                            sudoku.columnValues = new bool[sudoku.size * sudoku.size];
+                            sudoku.rowValues    = new bool[sudoku.size * sudoku.size];
+                            sudoku.blockValues  = new bool[sudoku.size * sudoku.size];
+                            std::memset(sudoku.columnValues, false, sizeof(bool) * sudoku.size * sudoku.size);
+                            std::memset(sudoku.rowValues,    false, sizeof(bool) * sudoku.size * sudoku.size);
+                            std::memset(sudoku.blockValues,  false, sizeof(bool) * sudoku.size * sudoku.size);
+                            blockSize = sudoku.blockSize;
+                            break;
                         }
                     }
                 }
             }
-            else {
-                if(line[2] == '-') {
-                    continue;
-                }
-                int column = 0;
-                int lineIndex = 2;
-                for(int blockIndex = 0; blockIndex < blockSize; blockIndex++) {
-                    for(int innerBlockIndex = 0; innerBlockIndex < blockSize; innerBlockIndex++) {
-                        if(line[lineIndex] == '_') {
-                            sudoku.field[column + sudoku.size * row] = -1;
+        }
+        else {
+            if(line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            if(line.size() < 3) {
+                return false;
+            }
+            if(line[2] == '-') {
+                continue;
+            }
+            if(row >= sudoku.size) {
+                return false;
+            }
+            int column = 0;
+            int lineIndex = 2;
+            for(int blockIndex = 0; blockIndex < blockSize; blockIndex++) {
+                for(int innerBlockIndex = 0; innerBlockIndex < blockSize; innerBlockIndex++) {
+                    if(lineIndex + sudoku.numberLength > line.size()) {
+                        return false;
+                    }
+                    if(line[lineIndex] == '_') {
+                        sudoku.field[column + sudoku.size * row] = -1;
+                    }
+                    else { 
+                        int value = std::stoi(line.substr(lineIndex, sudoku.numberLength)) - 1;
+                        if(value < 0 || value >= (int)sudoku.size) {
+                            return false;
                         }
-                        else { 
-                            int value = std::stoi(line.substr(lineIndex, sudoku.numberLength)) - 1;
-                            sudoku.field[column + sudoku.size * row] = value;
-                            sudoku.columnValues[value + column * sudoku.size] = true;
-                            sudoku.rowValues[value + row * sudoku.size] = true;
-                            int blockX = column / sudoku.blockSize;
-                            int blockY = row / sudoku.blockSize;
-                            sudoku.blockValues[value + (blockX * sudoku.size) + (blockY * sudoku.size * sudoku.blockSize)] = true;
+                        sudoku.field[column + sudoku.size * row] = value;
+                        sudoku.columnValues[value + column * sudoku.size] = true;
+                        sudoku.rowValues[value + row * sudoku.size] = true;
+                        int blockX = column / sudoku.blockSize;
+                        int blockY = row / sudoku.blockSize;
+                        sudoku.blockValues[value + (blockX * sudoku.size) + (blockY * sudoku.size * sudoku.blockSize)] = true;
 
-                        }
-                        lineIndex += sudoku.numberLength + 1;
-                        column++;
                     }
-                    lineIndex += 2;
+                    lineIndex += sudoku.numberLength + 1;
+                    column++;
                 }
-                row++;
+                lineIndex += 2;
             }
+            row++;
+        }
 
-            lineCount++;
+        lineCount++;
+    }
+    //every cell has to be read
+    return row == sudoku.size;
+}
+
+Sudoku readSudoku(std::istream &sudokuFile) {
+    Sudoku sudoku;
+
+    if(sudokuFile.good()) {
+        bool valid = false;
+        try {
+            valid = readSudokuLines(sudokuFile, sudoku);
+        }
+        catch(const std::exception &exception) {
+            std::cerr << "Failed to read sudoku: " << exception.what() << std::endl;
+        }
+        if(!valid) {
+            sudoku.free();
+            return Sudoku();
         }
     }
     return sudoku;
 }
 
 void encodeSudoku(Sudoku &sudoku) {
-    std::string cnf = "";
+    std::string cnf;
+    encodeSudoku(sudoku, cnf);
+}
+
+struct EncodeKernel {
+    Sudoku &sudoku;
+    std::string &cnf;
+
+    template<typename Grid>
+    int operator()(const Grid &grid) const {
+        encodeSudoku(sudoku, cnf, grid);
+        return 0;
+    }
+};
 
-    int gridSize = sudoku.size;
-    int blockSize = sqrt(gridSize);
+void encodeSudoku(Sudoku &sudoku, std::string &cnf) {
+    dispatchGrid<int>(sudoku, EncodeKernel{sudoku, cnf});
+}
+
+template<typename Grid>
+void encodeSudoku(Sudoku &sudoku, std::string &cnf, const Grid &grid) {
+    cnf.clear();
+
+    const int gridSize = grid.size();
+    const int blockSize = grid.blockSize();
 
     int clauses = 0;
-    int variables = pow(gridSize, 3);
 
     clock_t startTime = clock();
     int startClauses = 0;
@@ -240,12 +924,13 @@ void encodeSudoku(Sudoku &sudoku) {
     for(int x = 0; x < gridSize; x++) {
         for(int y = 0; y < gridSize; y++) {
             //prevent adding predifined cells
-            if(!sudoku.isCellValueSet(x, y)) {
+            if(!isCellValueSet(sudoku, grid, x, y)) {
                 int terms = 0;
                 for(int v = 0; v < gridSize; v++) {
                     //prevent add already set values 
-                    if(!sudoku.isValueSatisfied(x, y, v)) {
-                        cnf += valueToLiteral(sudoku, x, y, v) + " ";
+                    if(!isValueSatisfied(sudoku, grid, x, y, v)) {
+                        appendLiteral(cnf, sudoku, x, y, v);
+                        cnf += ' ';
                         terms++;
                     }                    
                 }
@@ -265,15 +950,18 @@ void encodeSudoku(Sudoku &sudoku) {
     for(int x = 0; x < gridSize; x++) {
         for(int y = 0; y < gridSize; y++) {
             //ignore predfined cells
-            if(!sudoku.isCellValueSet(x, y)) {
+            if(!isCellValueSet(sudoku, grid, x, y)) {
                 for(int v = 0; v < gridSize-1; v++) {
                     //uniquness check only matters on viable values v and w
                     //so only add [-v, -w] only if w and v are possible values on x,y
-                    if(!sudoku.isValueSatisfied(x, y, v)) {
+                    if(!isValueSatisfied(sudoku, grid, x, y, v)) {
                         for(int w = v+1; w < gridSize; w++) {
                             //only add possible values
-                            if(!sudoku.isValueSatisfied(x, y, w)) {
-                                cnf += valueToLiteral(sudoku, x, y, v, false) + " " + valueToLiteral(sudoku, x, y, w, false) + " 0\n";
+                            if(!isValueSatisfied(sudoku, grid, x, y, w)) {
+                                appendLiteral(cnf, sudoku, x, y, v, false);
+                                cnf += ' ';
+                                appendLiteral(cnf, sudoku, x, y, w, false);
+                                cnf += " 0\n";
                                 clauses++;
                             }
                         }
@@ -295,17 +983,20 @@ void encodeSudoku(Sudoku &sudoku) {
         //for each row
         for(int y = 0; y < gridSize - 1; y++) {
             //only look for cells (in row and test row) that are not predefined
-            if(!sudoku.isCellValueSet(x, y)) {
+            if(!isCellValueSet(sudoku, grid, x, y)) {
                 //for each test row
                 for(int w = y+1; w < gridSize; w++) {  
                     //dont compare the same cell  
-                    if(!sudoku.isCellValueSet(x, w)) {   
+                    if(!isCellValueSet(sudoku, grid, x, w)) {   
                         //if every cell is not already predfined
                         //check each value and only add the uniqueness constraint 
                         //if both cells are able to assign this value
                         for(int v = 0; v < gridSize; v++) {    
-                            if(!sudoku.isValueSatisfied(x, y, v) && !sudoku.isValueSatisfied(x, w, v)) {                    
-                                cnf += valueToLiteral(sudoku, x, y, v, false) + " " + valueToLiteral(sudoku, x, w, v, false) + " 0\n";
+                            if(!isValueSatisfied(sudoku, grid, x, y, v) && !isValueSatisfied(sudoku, grid, x, w, v)) {                    
+                                appendLiteral(cnf, sudoku, x, y, v, false);
+                                cnf += ' ';
+                                appendLiteral(cnf, sudoku, x, w, v, false);
+                                cnf += " 0\n";
                                 clauses++;    
                             }
                         }
@@ -325,8 +1016,9 @@ void encodeSudoku(Sudoku &sudoku) {
         for(int v = 0; v < gridSize; v++) {
             int terms = 0;
             for(int y = 0; y < gridSize; y++) {
-                if(!sudoku.isCellValueSet(x, y) && !sudoku.isValueSatisfied(x, y, v)) {
-                    cnf += valueToLiteral(sudoku, x, y, v) + " ";
+                if(!isCellValueSet(sudoku, grid, x, y) && !isValueSatisfied(sudoku, grid, x, y, v)) {
+                    appendLiteral(cnf, sudoku, x, y, v);
+                    cnf += ' ';
                     terms++;
                 }
             }
@@ -345,12 +1037,15 @@ void encodeSudoku(Sudoku &sudoku) {
     //uniqueness for rows
     for(int y = 0; y < gridSize; y++) {
         for(int x = 0; x < gridSize - 1; x++) {
-            if(!sudoku.isCellValueSet(x, y)) {
+            if(!isCellValueSet(sudoku, grid, x, y)) {
                 for(int w = x + 1; w < gridSize; w++) {  
-                    if(!sudoku.isCellValueSet(w, y)) {  
+                    if(!isCellValueSet(sudoku, grid, w, y)) {  
                         for(int v = 0; v < gridSize; v++) {   
-                            if(!sudoku.isValueSatisfied(x, y, v) && !sudoku.isValueSatisfied(w, y, v)) {                 
-                                cnf += valueToLiteral(sudoku, x, y, v, false) + " " + valueToLiteral(sudoku, w, y, v, false) + " 0\n";
+                            if(!isValueSatisfied(sudoku, grid, x, y, v) && !isValueSatisfied(sudoku, grid, w, y, v)) {                 
+                                appendLiteral(cnf, sudoku, x, y, v, false);
+                                cnf += ' ';
+                                appendLiteral(cnf, sudoku, w, y, v, false);
+                                cnf += " 0\n";
                                 clauses++;
                             }
                         }
@@ -371,8 +1066,9 @@ void encodeSudoku(Sudoku &sudoku) {
         for(int v = 0; v < gridSize; v++) {
             int terms = 0;
             for(int x = 0; x < gridSize; x++) {
-                if(!sudoku.isCellValueSet(x, y) && !sudoku.isValueSatisfied(x, y, v)) {
-                    cnf += valueToLiteral(sudoku, x, y, v) + " ";
+                if(!isCellValueSet(sudoku, grid, x, y) && !isValueSatisfied(sudoku, grid, x, y, v)) {
+                    appendLiteral(cnf, sudoku, x, y, v);
+                    cnf += ' ';
                     terms++;
                 }
             }
@@ -399,16 +1095,19 @@ void encodeSudoku(Sudoku &sudoku) {
                 for(int w = x+1; w < blockSize * i + blockSize; w++) {
                     //global y coordinate loop
                     for(int y = blockSize * j; y < blockSize * j + blockSize; y++) { 
-                        if(!sudoku.isCellValueSet(x, y)) {       
+                        if(!isCellValueSet(sudoku, grid, x, y)) {       
                             //global ref y loop
                             for(int k = y+1; k < blockSize * j + blockSize; k++) { 
                                 if(x == w && y == k) {
                                     continue;
                                 }
-                                if(!sudoku.isCellValueSet(w, k)) {
+                                if(!isCellValueSet(sudoku, grid, w, k)) {
                                     for(int v = 0; v < gridSize; v++) {
-                                        if(!sudoku.isValueSatisfied(x, y, v) && !sudoku.isValueSatisfied(w, k, v)) {
-                                            cnf += valueToLiteral(sudoku, x, y, v, false) + " " + valueToLiteral(sudoku, w, k, v, false) + " 0\n";
+                                        if(!isValueSatisfied(sudoku, grid, x, y, v) && !isValueSatisfied(sudoku, grid, w, k, v)) {
+                                            appendLiteral(cnf, sudoku, x, y, v, false);
+                                            cnf += ' ';
+                                            appendLiteral(cnf, sudoku, w, k, v, false);
+                                            cnf += " 0\n";
                                             clauses++;
                                         }
                                     }
@@ -432,9 +1131,10 @@ void encodeSudoku(Sudoku &sudoku) {
                 //global x coordinate loop
                 for(int x = blockSize * i; x < blockSize * i + blockSize; x++) {
                     for(int y = blockSize * j; y < blockSize * j + blockSize; y++) { 
-                        if(!sudoku.isCellValueSet(x, y)) {
-                            if(!sudoku.isValueSatisfied(x, y, v)) {
-                                cnf += valueToLiteral(sudoku, x, y, v) + " ";
+                        if(!isCellValueSet(sudoku, grid, x, y)) {
+                            if(!isValueSatisfied(sudoku, grid, x, y, v)) {
+                                appendLiteral(cnf, sudoku, x, y, v);
+                                cnf += ' ';
                                 terms++;
                             }
                         }
@@ -468,89 +1168,275 @@ void encodeSudoku(Sudoku &sudoku) {
     
 }
 
-std::string valueToLiteral(Sudoku &sudoku, int x, int y, int v, bool isTrue) {
-    std::string negate = isTrue ? "" : "-";
-    //add offset by 1 bc sat solver literals start by 1
-    std::string value = std::to_string(y * sudoku.size * sudoku.size + (x * sudoku.size) + v + 1);
+struct EncodePbKernel {
+    Sudoku &sudoku;
+    std::string &opb;
 
-    //add new values to our cnf mapping for compact encoding
-    int mappedValue = 0;
-    auto mapping = sudoku.mappingLiteralIndexToValueIndex.find(value);
-    if(mapping == sudoku.mappingLiteralIndexToValueIndex.end()) {
-        sudoku.mappingLiteralIndexToValue.push_back(value);
-        mappedValue = sudoku.mappingLiteralIndexToValue.size();
-        sudoku.mappingLiteralIndexToValueIndex[value] = mappedValue-1;
-    }
-    else {
-        mappedValue = sudoku.mappingLiteralIndexToValueIndex[value] + 1;
+    template<typename Grid>
+    int operator()(const Grid &grid) const {
+        encodeSudokuPb(sudoku, opb, grid);
+        return 0;
     }
+};
 
-    return negate + std::to_string(mappedValue);
+void encodeSudokuPb(Sudoku &sudoku, std::string &opb) {
+    dispatchGrid<int>(sudoku, EncodePbKernel{sudoku, opb});
 }
 
-void literalToValue(Sudoku &sudoku, int &x, int &y, int &v, int value) {
+bool isPseudoBooleanSolver(std::string solver) {
+    return solver == "clasp-opb";
+}
 
-    //get value from compact encoding
-    value = std::stoi(sudoku.mappingLiteralIndexToValue[value-1]);
-
-    value--;
-
-    int rowLength = sudoku.size * sudoku.size;
-    for(y = 0; y < sudoku.size; y++) {
-        if((y+1) * rowLength > value) {
-            value -= y * rowLength;
-            for(x = 0; x < sudoku.size; x++) {
-                if((x+1) * sudoku.size > value) {
-                    value -= x * sudoku.size;
-                    v = value;
-                    break;
+template<typename Grid>
+void encodeSudokuPb(Sudoku &sudoku, std::string &opb, const Grid &grid) {
+    opb.clear();
+
+    const int gridSize = grid.size();
+    const int blockSize = grid.blockSize();
+
+    int constraints = 0;
+
+    clock_t startTime = clock();
+
+    //exactly one value per cell
+    for(int x = 0; x < gridSize; x++) {
+        for(int y = 0; y < gridSize; y++) {
+            if(!isCellValueSet(sudoku, grid, x, y)) {
+                int terms = 0;
+                for(int v = 0; v < gridSize; v++) {
+                    if(!isValueSatisfied(sudoku, grid, x, y, v)) {
+                        opb += "+1 x";
+                        appendLiteral(opb, sudoku, x, y, v);
+                        opb += ' ';
+                        terms++;
+                    }
+                }
+                if(terms > 0) {
+                    opb += "= 1 ;\n";
+                    constraints++;
                 }
             }
-            break;
         }
     }
+
+    //exactly one cell per value in each column
+    for(int x = 0; x < gridSize; x++) {
+        for(int v = 0; v < gridSize; v++) {
+            int terms = 0;
+            for(int y = 0; y < gridSize; y++) {
+                if(!isCellValueSet(sudoku, grid, x, y) && !isValueSatisfied(sudoku, grid, x, y, v)) {
+                    opb += "+1 x";
+                    appendLiteral(opb, sudoku, x, y, v);
+                    opb += ' ';
+                    terms++;
+                }
+            }
+            if(terms > 0) {
+                opb += "= 1 ;\n";
+                constraints++;
+            }
+        }
+    }
+
+    //exactly one cell per value in each row
+    for(int y = 0; y < gridSize; y++) {
+        for(int v = 0; v < gridSize; v++) {
+            int terms = 0;
+            for(int x = 0; x < gridSize; x++) {
+                if(!isCellValueSet(sudoku, grid, x, y) && !isValueSatisfied(sudoku, grid, x, y, v)) {
+                    opb += "+1 x";
+                    appendLiteral(opb, sudoku, x, y, v);
+                    opb += ' ';
+                    terms++;
+                }
+            }
+            if(terms > 0) {
+                opb += "= 1 ;\n";
+                constraints++;
+            }
+        }
+    }
+
+    //exactly one cell per value in each block
+    for(int i = 0; i < blockSize; i++) {
+        for(int j = 0; j < blockSize; j++) {
+            for(int v = 0; v < gridSize; v++) {
+                int terms = 0;
+                for(int x = blockSize * i; x < blockSize * i + blockSize; x++) {
+                    for(int y = blockSize * j; y < blockSize * j + blockSize; y++) {
+                        if(!isCellValueSet(sudoku, grid, x, y) && !isValueSatisfied(sudoku, grid, x, y, v)) {
+                            opb += "+1 x";
+                            appendLiteral(opb, sudoku, x, y, v);
+                            opb += ' ';
+                            terms++;
+                        }
+                    }
+                }
+                if(terms > 0) {
+                    opb += "= 1 ;\n";
+                    constraints++;
+                }
+            }
+        }
+    }
+
+    std::cerr << "Pb " << (double(clock() - startTime) / CLOCKS_PER_SEC) << "s " << constraints << " Constraints" << std::endl;
+    startTime = clock();
+
+    std::fstream opbFile = std::fstream("sudoku.opb", std::fstream::out);
+    if(opbFile.good()) {
+        opbFile << "* #variable= " + std::to_string(sudoku.mappingLiteralIndexToValue.size()) + " #constraint= " + std::to_string(constraints) + "\n";
+        opbFile << "* (" + std::to_string(sudoku.size) + "x" + std::to_string(sudoku.size) + ")-Sudoku\n";
+        opbFile << opb;
+    }
+    opbFile.close();
+
+    std::cerr << "Write " << (double(clock() - startTime) / CLOCKS_PER_SEC) << "s" << std::endl;
 }
 
-void solve(std::string solver) {
-    /*pid_t pid = fork(); 
+/**
+ * @brief Maps x/y/v to its compact literal, new values get the next free one
+ * 
+ * @param sudoku 
+ * @param x 
+ * @param y 
+ * @param v 
+ * @return int compact literal (starting by 1)
+ */
+static int mapLiteral(Sudoku &sudoku, int x, int y, int v) {
+    if(mappingLiteralIndexToValueIndex.size() < sudoku.size * sudoku.size * sudoku.size) {
+        mappingLiteralIndexToValueIndex.resize(sudoku.size * sudoku.size * sudoku.size, 0);
+    }
+    int value = y * sudoku.size * sudoku.size + (x * sudoku.size) + v;
+
+    //add new values to our cnf mapping for compact encoding
+    int &mappedValue = mappingLiteralIndexToValueIndex[value];
+    if(mappedValue <= 0 || mappedValue > (int)sudoku.mappingLiteralIndexToValue.size()
+        || sudoku.mappingLiteralIndexToValue[mappedValue - 1] != value + 1) {
+        //add offset by 1 bc sat solver literals start by 1
+        sudoku.mappingLiteralIndexToValue.push_back(value + 1);
+        mappedValue = sudoku.mappingLiteralIndexToValue.size();
+    }
+    return mappedValue;
+}
+
+std::string valueToLiteral(Sudoku &sudoku, int x, int y, int v, bool isTrue) {
+    std::string literal;
+    appendLiteral(literal, sudoku, x, y, v, isTrue);
+    return literal;
+}
+
+void appendLiteral(std::string &out, Sudoku &sudoku, int x, int y, int v, bool isTrue) {
+    if(!isTrue) {
+        out += '-';
+    }
+    char digits[16];
+    int length = 0;
+    int mappedValue = mapLiteral(sudoku, x, y, v);
+    do {
+        digits[length++] = '0' + mappedValue % 10;
+        mappedValue /= 10;
+    } while(mappedValue > 0);
+    while(length > 0) {
+        out += digits[--length];
+    }
+}
+
+void literalToValue(Sudoku &sudoku, int &x, int &y, int &v, int value) {
+
+    //get value from compact encoding
+    value = sudoku.mappingLiteralIndexToValue[value-1] - 1;
+
+    y = value / (sudoku.size * sudoku.size);
+    x = (value / sudoku.size) % sudoku.size;
+    v = value % sudoku.size;
+}
+
+/**
+ * @brief Starts the solver without a shell, stdout is redirected to sudoku.sol
+ * 
+ * @param argv null terminated solver command line
+ */
+static void runSolverProcess(const char * const argv[]) {
+    pid_t pid = fork(); 
 
     if(pid == -1) {
-        printf("Failed to create solver process\n");
+        std::cerr << "Failed to create solver process" << std::endl;
     }
     else if(pid == 0) {
-        //redirect stdout to sudoku.sol
-        int fd = open("sudoku.sol", O_CREAT | O_WRONLY);
-        dup2(fd, 1);
-
-        if(solver == "clasp") {
-            //system("clasp sudoku.cnf > sudoku.sol");
-            char *argv[] = {"clasp", "sudoku.cnf", 0 };
-            execvp(argv[0], argv);    
+        //own process group in server mode, so a cancel also stops
+        //processes started by the solver (e.g. wrapper scripts)
+        if(solverClientFd >= 0) {
+            setpgid(0, 0);
         }
-        if(solver == "riss") {
-            //system("riss sudoku.cnf > sudoku.sol");
-            char *argv[] = {"riss", "sudoku.cnf", 0 };
-            execvp(argv[0], argv);   
+        //redirect stdout to sudoku.sol
+        int fd = open("sudoku.sol", O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if(fd < 0) {
+            _exit(EXIT_FAILURE);
         }
-        exit(EXIT_SUCCESS);
+        dup2(fd, 1);
+        close(fd);
+        execvp(argv[0], (char * const *)argv);
+        _exit(127);
+    }
+    else if(solverClientFd < 0) {
+        int status;
+        while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
     }
     else {
-        wait(NULL);
-    }*/
+        //server mode: stop the solver as soon as the client hangs up
+        setpgid(pid, pid);
+        serverSolverPid = pid;
+        int status;
+        while(true) {
+            pid_t result = waitpid(pid, &status, WNOHANG);
+            if(result == pid || (result < 0 && errno != EINTR)) {
+                break;
+            }
+            pollfd fds[2] = {{childPipe[0], POLLIN, 0}, {solverClientFd, 0, 0}};
+            if(poll(fds, 2, -1) < 0) {
+                continue;
+            }
+            if(fds[0].revents & POLLIN) {
+                char buffer[64];
+                while(read(childPipe[0], buffer, sizeof(buffer)) > 0) {}
+            }
+            if(fds[1].revents & (POLLHUP | POLLERR)) {
+                killpg(pid, SIGKILL);
+                while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+                solverCancelled = true;
+                break;
+            }
+        }
+        serverSolverPid = -1;
+    }
+}
+
+bool isKnownSolver(std::string solver) {
+    return solver == "clasp" || solver == "riss" || solver == "glucose" || solver == "clasp-opb";
+}
 
+void solve(std::string solver) {
     if(solver == "clasp") {
-       system("clasp sudoku.cnf > sudoku.sol"); 
+        const char * argv[] = {"clasp", "sudoku.cnf", nullptr};
+        runSolverProcess(argv);
     }
     if(solver == "riss") {
-        system("riss sudoku.cnf > sudoku.sol");
+        const char * argv[] = {"riss", "sudoku.cnf", nullptr};
+        runSolverProcess(argv);
     }
     if(solver == "glucose")  {
-        system("glucose -model sudoku.cnf > sudoku.sol");
+        const char * argv[] = {"glucose", "-model", "sudoku.cnf", nullptr};
+        runSolverProcess(argv);
+    }
+    if(solver == "clasp-opb") {
+        const char * argv[] = {"clasp", "sudoku.opb", nullptr};
+        runSolverProcess(argv);
     }
 }
 
 void parseSolution(std::string solver, Sudoku &sudoku) {
-    if(solver == "clasp" || solver == "riss" || solver == "glucose") {
+    if(isKnownSolver(solver)) {
         std::fstream solutionFile("sudoku.sol", std::fstream::in);
 
         int lineCount = 0;
@@ -582,9 +1468,17 @@ void parseSolution(std::string solver, Sudoku &sudoku) {
                                     else {     
                                         valueStr = line.substr(valueStartIndex, lineIndex - valueStartIndex);                               
                                     }
-                                    value = std::stoi(valueStr);
+                                    //pseudo-Boolean models name the variables x1, -x2, ...
+                                    size_t digitIndex = valueStr.find_first_of("0123456789");
+                                    if(digitIndex == std::string::npos) {
+                                        continue;
+                                    }
+                                    value = std::stoi(valueStr.substr(digitIndex));
+                                    if(valueStr.find('-') < digitIndex) {
+                                        value = -value;
+                                    }
 
-                                    if(value > 0) {
+                                    if(value > 0 && value <= (int)sudoku.mappingLiteralIndexToValue.size()) {
                                         int x, y, v;
                                         literalToValue(sudoku, x, y, v, value);
                                         int fieldIndex = x + y * sudoku.size;
@@ -621,36 +1515,64 @@ void Sudoku::set(int x, int y, int value) {
     blockValues[value + (blockX * size) + (blockY * size * blockSize)] = true;
 }
 
-bool Sudoku::isCellValueSet(int x, int y) const {
-    return get(x, y) >= 0;
-}
+struct ReduceEasyFieldsKernel {
+    Sudoku &sudoku;
 
-bool Sudoku::isValueSatisfied(int x, int y, int value, bool checkBlock, bool checkColumn, bool checkRow) const {
-    if(checkColumn && columnValues[value + x * size]) {
-        return true;
+    template<typename Grid>
+    int operator()(const Grid &grid) const {
+        return reduceEasyFields(sudoku, grid);
     }
-    if(checkRow && rowValues[value + y * size]) {
-        return true;
-    }
-    if(checkBlock) {
-        int blockX = x / blockSize;
-        int blockY = y / blockSize;
-        if(blockValues[value + (blockX * size) + (blockY * size * blockSize)]) {
-            return true;
-        }
+};
+
+int Sudoku::reduceEasyFields() {
+    return dispatchGrid<int>(*this, ReduceEasyFieldsKernel{*this});
+}
+
+template<typename Result, typename Kernel>
+Result dispatchGrid(const Sudoku &sudoku, Kernel kernel) {
+    //only the sizes of the instance tables (9x9 up to 225x225),
+    //every case is another copy of each kernel
+    switch(sudoku.blockSize) {
+        case 3:  return kernel(FixedGrid<3>(sudoku));
+        case 4:  return kernel(FixedGrid<4>(sudoku));
+        case 5:  return kernel(FixedGrid<5>(sudoku));
+        case 6:  return kernel(FixedGrid<6>(sudoku));
+        case 7:  return kernel(FixedGrid<7>(sudoku));
+        case 8:  return kernel(FixedGrid<8>(sudoku));
+        case 10: return kernel(FixedGrid<10>(sudoku));
+        case 12: return kernel(FixedGrid<12>(sudoku));
+        case 15: return kernel(FixedGrid<15>(sudoku));
+        default: return kernel(RuntimeGrid(sudoku));
     }
-    return false;
 }
 
-int Sudoku::reduceEasyFields() {
+template<typename Grid>
+bool isCellValueSet(const Sudoku &sudoku, const Grid &grid, int x, int y) {
+    return sudoku.field[x + y * grid.size()] >= 0;
+}
+
+template<typename Grid>
+bool isValueSatisfied(const Sudoku &sudoku, const Grid &grid, int x, int y, int value) {
+    const int size = grid.size();
+    const int blockSize = grid.blockSize();
+    int blockX = x / blockSize;
+    int blockY = y / blockSize;
+    return sudoku.columnValues[value + x * size]
+        || sudoku.rowValues[value + y * size]
+        || sudoku.blockValues[value + (blockX * size) + (blockY * size * blockSize)];
+}
+
+template<typename Grid>
+int reduceEasyFields(Sudoku &sudoku, const Grid &grid) {
+    const int size = grid.size();
     int optimizations = 0;
     for(int x = 0; x < size; x++) {
         for(int y = 0; y < size; y++) {
-            if(!isCellValueSet(x, y)) {
+            if(!isCellValueSet(sudoku, grid, x, y)) {
                 int possibilities = 0;
                 int possibleValue = 0;
                 for(int v = 0; v < size; v++) {
-                    if(!isValueSatisfied(x, y, v)) {
+                    if(!isValueSatisfied(sudoku, grid, x, y, v)) {
                         possibilities++;
                         possibleValue = v;
                         if(possibilities > 1) {
@@ -659,7 +1581,7 @@ int Sudoku::reduceEasyFields() {
                     }
                 }
                 if(possibilities == 1) {
-                    set(x, y, possibleValue);
+                    sudoku.set(x, y, possibleValue);
                     optimizations++;
                 }
             }
@@ -669,39 +1591,93 @@ int Sudoku::reduceEasyFields() {
     return optimizations;
 }
 
-void Sudoku::print() const {
-    std::cout << parameters;
-    int blockSize = sqrt(size);
-    for(int y = 0; y < size; y++) {
-        if(y % blockSize == 0) {
-            for(int blockIndex = 0; blockIndex < blockSize; blockIndex++) {
-                std::cout << "+" << std::string(blockSize * (numberLength+1) + 1, '-');
-                if(blockIndex == blockSize-1) {
-                    std::cout << "+" << std::endl;
+bool Sudoku::verify(const std::vector<int> &clues) const {
+    //only the first problems are listed, a mostly empty 225x225 result
+    //would otherwise print one line per cell
+    const unsigned int maxReportedProblems = 10;
+    unsigned int problems = 0;
+
+    //one bit per value for every row, column and block
+    const unsigned int words = (size + 63) / 64;
+    std::vector<uint64_t> rowSeen(size * words, 0);
+    std::vector<uint64_t> columnSeen(size * words, 0);
+    std::vector<uint64_t> blockSeen(size * words, 0);
+
+    for(unsigned int y = 0; y < size; y++) {
+        for(unsigned int x = 0; x < size; x++) {
+            int value = get(x, y);
+            int clue = clues[x + y * size];
+            if(value < 0 || (unsigned int)value >= size) {
+                if(problems++ < maxReportedProblems) {
+                    std::cerr << "Verify: cell " << x << "x" << y << " not set" << std::endl;
                 }
+                continue;
             }
-        }
-        for(int x = 0; x < size; x++) {
-            if(x % (int)sqrt(size) == 0) {
-                std::cout << "| ";
+            if(clue >= 0 && clue != value) {
+                if(problems++ < maxReportedProblems) {
+                    std::cerr << "Verify: cell " << x << "x" << y << " = " << value + 1 << " overrides clue " << clue + 1 << std::endl;
+                }
             }
-            std::string valueStr = std::to_string(get(x, y) + 1);
-            std::cout << std::string(numberLength - valueStr.length(), ' ') << valueStr << " ";
-            if(x == size-1) {
-                std::cout << "|";
+
+            unsigned int word = value / 64;
+            uint64_t bit = uint64_t(1) << (value % 64);
+            uint64_t &row = rowSeen[y * words + word];
+            uint64_t &column = columnSeen[x * words + word];
+            uint64_t &block = blockSeen[((x / blockSize) + (y / blockSize) * blockSize) * words + word];
+            if((row | column | block) & bit) {
+                if(problems++ < maxReportedProblems) {
+                    std::cerr << "Verify: value " << value + 1 << " at " << x << "x" << y << " is not unique" << std::endl;
+                }
             }
+            row |= bit;
+            column |= bit;
+            block |= bit;
         }
-        std::cout << std::endl;
-        if(y == size-1) {
-            for(int blockIndex = 0; blockIndex < blockSize; blockIndex++) {
-                std::cout << "+" << std::string(blockSize * (numberLength+1) + 1, '-');
-                if(blockIndex == blockSize-1) {
-                    std::cout << "+" << std::endl;
-                }
+    }
+    if(problems > maxReportedProblems) {
+        std::cerr << "Verify: " << problems << " problems in total" << std::endl;
+    }
+    return problems == 0;
+}
+
+void Sudoku::render(std::string &out) const {
+    const unsigned int lineLength = blockSize * (blockSize * (numberLength + 1) + 3) + 1;
+    out.reserve(out.size() + parameters.size() + (size + blockSize + 1) * (lineLength + 1));
+    out += parameters;
+
+    std::string separator;
+    for(unsigned int blockIndex = 0; blockIndex < blockSize; blockIndex++) {
+        separator += "+" + std::string(blockSize * (numberLength+1) + 1, '-');
+    }
+    separator += "+\n";
+
+    for(unsigned int y = 0; y < size; y++) {
+        if(y % blockSize == 0) {
+            out += separator;
+        }
+        for(unsigned int x = 0; x < size; x++) {
+            if(x % blockSize == 0) {
+                out += "| ";
             }
+            //right aligned number, unset cells are printed as 0
+            size_t end = out.size() + numberLength;
+            out.append(numberLength, ' ');
+            int value = get(x, y) + 1;
+            do {
+                out[--end] = '0' + value % 10;
+                value /= 10;
+            } while(value > 0 && end > out.size() - numberLength);
+            out += ' ';
         }
+        out += "|\n";
     }
+    out += separator;
+}
 
+void Sudoku::print() const {
+    std::string output;
+    render(output);
+    writeAll(STDOUT_FILENO, output.data(), output.size());
 }
 
 void Sudoku::free() {
@@ -709,6 +1685,10 @@ void Sudoku::free() {
     delete[] columnValues;
     delete[] rowValues;
     delete[] blockValues;
+    field = nullptr;
+    columnValues = nullptr;
+    rowValues = nullptr;
+    blockValues = nullptr;
 }
 
 void validate(Sudoku & sudoku) {